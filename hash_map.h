@@ -0,0 +1,601 @@
+#pragma once
+
+#include <emmintrin.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Minimal allocator that over-aligns every block to `Alignment` bytes, so
+// the probe arrays start on a cache-line boundary and a 16-byte group load
+// never straddles two lines.
+template <class T, size_t Alignment>
+class AlignedAllocator {
+ public:
+    using value_type = T;
+
+    AlignedAllocator() = default;
+
+    template <class U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+    template <class U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    T* allocate(size_t count) {
+        size_t bytes = count * sizeof(T);
+        bytes = (bytes + Alignment - 1) / Alignment * Alignment;
+        void* result = std::aligned_alloc(Alignment, bytes);
+        if (result == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(result);
+    }
+
+    void deallocate(T* pointer, size_t) {
+        std::free(pointer);
+    }
+
+    bool operator==(const AlignedAllocator&) const {
+        return true;
+    }
+
+    bool operator!=(const AlignedAllocator&) const {
+        return false;
+    }
+};
+
+// splitmix64 finalizer. libstdc++'s std::hash for integers is the identity,
+// which clusters catastrophically once slot selection is a power-of-two
+// mask: every key lands in the group of its own low bits. This mixes all
+// input bits into the low bits with two multiply-xorshift rounds.
+struct IntegerHash {
+    size_t operator()(uint64_t value) const {
+        value ^= value >> 30;
+        value *= 0xbf58476d1ce4e5b9ULL;
+        value ^= value >> 27;
+        value *= 0x94d049bb133111ebULL;
+        value ^= value >> 31;
+        return static_cast<size_t>(value);
+    }
+};
+
+// Default hasher: the mixing hash for integral keys, std::hash otherwise.
+template <class KeyType>
+using DefaultHash = std::conditional_t<std::is_integral<KeyType>::value,
+                                       IntegerHash, std::hash<KeyType>>;
+
+// Hash map with open addressing (linear probing over 16-slot groups).
+// Elements are stored inline in a contiguous vector; `place_` maps a probe
+// slot to an index into `elements_`. Deletion swap-and-pops the element
+// array and re-probes the moved element's key to patch its slot.
+// A parallel byte array `metadata_` holds the low 7 bits of each slot's hash
+// (or an empty/tombstone marker), so a probe compares 16 candidate slots with
+// one SSE2 instruction and only touches `elements_` on a tag match.
+template <class KeyType, class ValueType, class Hash = DefaultHash<KeyType>>
+class HashMap {
+ public:
+    using Element = std::pair<KeyType, ValueType>;
+
+    class iterator {
+     public:
+        iterator() = default;
+
+        iterator(HashMap* map, size_t pointer) : map_(map), pointer_(pointer) {}
+
+        iterator& operator++() {
+            ++pointer_;
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator result = *this;
+            ++pointer_;
+            return result;
+        }
+
+        std::pair<const KeyType, ValueType>& operator*() const {
+            return reinterpret_cast<std::pair<const KeyType, ValueType>&>(
+                map_->elements_[pointer_]);
+        }
+
+        std::pair<const KeyType, ValueType>* operator->() const {
+            return &**this;
+        }
+
+        bool operator==(const iterator& other) const {
+            return pointer_ == other.pointer_;
+        }
+
+        bool operator!=(const iterator& other) const {
+            return pointer_ != other.pointer_;
+        }
+
+     private:
+        HashMap* map_ = nullptr;
+        size_t pointer_ = 0;
+    };
+
+    class const_iterator {
+     public:
+        const_iterator() = default;
+
+        const_iterator(const HashMap* map, size_t pointer)
+            : map_(map), pointer_(pointer) {}
+
+        const_iterator& operator++() {
+            ++pointer_;
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator result = *this;
+            ++pointer_;
+            return result;
+        }
+
+        const std::pair<const KeyType, ValueType>& operator*() const {
+            return reinterpret_cast<const std::pair<const KeyType, ValueType>&>(
+                map_->elements_[pointer_]);
+        }
+
+        const std::pair<const KeyType, ValueType>* operator->() const {
+            return &**this;
+        }
+
+        bool operator==(const const_iterator& other) const {
+            return pointer_ == other.pointer_;
+        }
+
+        bool operator!=(const const_iterator& other) const {
+            return pointer_ != other.pointer_;
+        }
+
+     private:
+        const HashMap* map_ = nullptr;
+        size_t pointer_ = 0;
+    };
+
+    explicit HashMap(Hash hasher = Hash()) : hasher_(hasher) {
+        Rebuild();
+    }
+
+    template <class ForwardIt>
+    HashMap(ForwardIt begin, ForwardIt end, Hash hasher = Hash())
+        : hasher_(hasher) {
+        // Forward iterators are multipass, so the element count is known up
+        // front and the table can be sized once instead of doubling (and
+        // fully rehashing) O(log n) times during the insert loop.
+        Rebuild(static_cast<size_t>(std::distance(begin, end)));
+        for (ForwardIt it = begin; it != end; ++it) {
+            insert(*it);
+        }
+    }
+
+    HashMap(std::initializer_list<Element> list, Hash hasher = Hash())
+        : HashMap(list.begin(), list.end(), hasher) {}
+
+    HashMap(const HashMap& other) = default;
+
+    HashMap(HashMap&& other) : HashMap(other.hasher_) {
+        *this = std::move(other);
+    }
+
+    HashMap& operator=(const HashMap& other) {
+        if (this != &other) {
+            HashMap temp(other);
+            *this = std::move(temp);
+        }
+        return *this;
+    }
+
+    // Swap-based, so assignment moves no elements and the moved-from map
+    // is left in a usable state.
+    HashMap& operator=(HashMap&& other) noexcept {
+        std::swap(elements_, other.elements_);
+        std::swap(metadata_, other.metadata_);
+        std::swap(place_, other.place_);
+        std::swap(mask_, other.mask_);
+        std::swap(tombstones_, other.tombstones_);
+        std::swap(hasher_, other.hasher_);
+        return *this;
+    }
+
+    size_t size() const {
+        return elements_.size();
+    }
+
+    bool empty() const {
+        return elements_.empty();
+    }
+
+    Hash hash_function() const {
+        return hasher_;
+    }
+
+    void insert(const Element& value) {
+        size_t id = FindPlace(value.first);
+        if (metadata_[id] == kEmpty) {
+            AddElement(value);
+        }
+    }
+
+    void insert(Element&& value) {
+        size_t id = FindPlace(value.first);
+        if (metadata_[id] == kEmpty) {
+            AddElement(std::move(value));
+        }
+    }
+
+    template <class K, class V>
+    void emplace(K&& key, V&& value) {
+        size_t id = FindPlace(key);
+        if (metadata_[id] == kEmpty) {
+            AddElement(Element(std::forward<K>(key), std::forward<V>(value)));
+        }
+    }
+
+    void erase(const KeyType& key) {
+        size_t id = FindPlace(key);
+        if (metadata_[id] != kEmpty) {
+            DeleteElement(id);
+        }
+    }
+
+    iterator find(const KeyType& key) {
+        size_t id = FindPlace(key);
+        if (metadata_[id] == kEmpty) {
+            return end();
+        }
+        return iterator(this, place_[id].index);
+    }
+
+    const_iterator find(const KeyType& key) const {
+        size_t id = FindPlace(key);
+        if (metadata_[id] == kEmpty) {
+            return end();
+        }
+        return const_iterator(this, place_[id].index);
+    }
+
+    ValueType& operator[](const KeyType& key) {
+        size_t id = FindPlace(key);
+        if (metadata_[id] == kEmpty) {
+            // The element index is stable across Rebuild (only the probe
+            // arrays are re-slotted), so no second probe is needed.
+            return elements_[AddElement(Element(key, ValueType()))].second;
+        }
+        return elements_[place_[id].index].second;
+    }
+
+    const ValueType& at(const KeyType& key) const {
+        size_t id = FindPlace(key);
+        if (metadata_[id] == kEmpty) {
+            throw std::out_of_range("HashMap::at: key not found");
+        }
+        return elements_[place_[id].index].second;
+    }
+
+    iterator begin() {
+        return iterator(this, 0);
+    }
+
+    iterator end() {
+        return iterator(this, elements_.size());
+    }
+
+    const_iterator begin() const {
+        return const_iterator(this, 0);
+    }
+
+    const_iterator end() const {
+        return const_iterator(this, elements_.size());
+    }
+
+    void clear() {
+        elements_.clear();
+        Rebuild();
+    }
+
+    // Grows the table so `count` elements fit without another rehash.
+    void reserve(size_t count) {
+        // Mirrors the AddElement guard; past kMaxElements the sizing
+        // arithmetic below would overflow and wrap.
+        if (count > kMaxElements) {
+            throw std::length_error("HashMap: element count limit reached");
+        }
+        if (count * kSizeChange + 1 > place_.size()) {
+            Rebuild(count);
+        }
+    }
+
+    // Issues prefetches for `key`'s home probe group. Callers doing batch
+    // lookups can call this a few keys ahead of find() to overlap the
+    // memory latency of several probes.
+    void prefetch(const KeyType& key) const {
+        size_t group = HomeGroup(hasher_(key));
+        __builtin_prefetch(&metadata_[group], 0, 0);
+        __builtin_prefetch(&place_[group], 0, 0);
+    }
+
+    // Looks up `count` keys and writes one iterator (or end()) per key to
+    // `out`. Probe data is prefetched kLookahead keys ahead of the probe
+    // itself, so the cache misses of consecutive lookups overlap instead of
+    // being paid one after another.
+    void find_many(const KeyType* keys, size_t count, iterator* out) {
+        for (size_t i = 0; i < count && i < kLookahead; ++i) {
+            prefetch(keys[i]);
+        }
+        for (size_t i = 0; i < count; ++i) {
+            if (i + kLookahead < count) {
+                prefetch(keys[i + kLookahead]);
+            }
+            out[i] = find(keys[i]);
+        }
+    }
+
+    // Bulk-insert counterpart to find_many: the probe groups of upcoming
+    // keys are prefetched while the current key is being placed. A rebuild
+    // mid-batch only wastes the few prefetches already in flight.
+    void insert_many(const Element* values, size_t count) {
+        for (size_t i = 0; i < count && i < kLookahead; ++i) {
+            prefetch(values[i].first);
+        }
+        for (size_t i = 0; i < count; ++i) {
+            if (i + kLookahead < count) {
+                prefetch(values[i + kLookahead].first);
+            }
+            insert(values[i]);
+        }
+    }
+
+    void find_many(const KeyType* keys, size_t count,
+                   const_iterator* out) const {
+        for (size_t i = 0; i < count && i < kLookahead; ++i) {
+            prefetch(keys[i]);
+        }
+        for (size_t i = 0; i < count; ++i) {
+            if (i + kLookahead < count) {
+                prefetch(keys[i + kLookahead]);
+            }
+            out[i] = find(keys[i]);
+        }
+    }
+
+ private:
+    static constexpr size_t kCacheLineSize = 64;
+
+    template <class T>
+    using AlignedVector = std::vector<T, AlignedAllocator<T, kCacheLineSize>>;
+
+    static constexpr uint8_t kEmpty = 0x80;
+    static constexpr uint8_t kTombstone = 0xFE;
+    static constexpr uint8_t kTagMask = 0x7F;
+    static constexpr size_t kGroupSize = 16;
+    static constexpr size_t kSizeChange = 2;
+    static constexpr size_t kLookahead = 8;
+
+    // One probe slot: the memoized 32-bit hash of the resident key plus its
+    // index into elements_. Rejecting on `hash` first means a 7-bit tag
+    // collision almost never has to dereference elements_ for the key
+    // comparison.
+    struct Slot {
+        uint32_t hash;
+        uint32_t index;
+    };
+
+    static_assert(sizeof(Slot) == 2 * sizeof(uint32_t),
+                  "Slot must stay 8 bytes so 8 slots fit per cache line");
+
+    // Keeps element indices within uint32_t and the table capacity within
+    // 32 bits, so HomeGroup computed from a memoized hash stays exact.
+    static constexpr size_t kMaxElements =
+        static_cast<size_t>(UINT32_MAX) / kSizeChange;
+
+    static uint8_t Tag(size_t hash) {
+        return hash & kTagMask;
+    }
+
+    size_t HomeGroup(size_t hash) const {
+        return (hash & mask_) & ~(kGroupSize - 1);
+    }
+
+    // Returns the slot holding `key`, or the first empty slot of its probe
+    // sequence if the key is absent. Scans kGroupSize metadata tags per
+    // iteration; `elements_` is only dereferenced on a 7-bit tag match.
+    // The table state is hoisted into restrict-qualified locals so the
+    // compiler keeps it in registers across the whole probe loop instead of
+    // reloading through the vector headers every iteration — the probe body
+    // the template instantiates is then fully specialized for the key type.
+    // Forced inline: every public accessor funnels through here, and
+    // inlining lets the hash, mask and SIMD constants fold into the caller.
+    __attribute__((always_inline)) inline size_t FindPlace(
+        const KeyType& key) const {
+        const uint8_t* __restrict metadata = metadata_.data();
+        const Slot* __restrict place = place_.data();
+        const size_t mask = mask_;
+        size_t hash = hasher_(key);
+        uint32_t hash32 = static_cast<uint32_t>(hash);
+        __m128i target = _mm_set1_epi8(static_cast<char>(Tag(hash)));
+        __m128i empty = _mm_set1_epi8(static_cast<char>(kEmpty));
+        size_t group = (hash & mask) & ~(kGroupSize - 1);
+        // The slot indices are only needed after a tag hit, so start their
+        // line towards the core while the metadata group is being scanned.
+        __builtin_prefetch(&place[group], 0, 0);
+        for (;;) {
+            __m128i meta = _mm_load_si128(
+                reinterpret_cast<const __m128i*>(&metadata[group]));
+            uint32_t hits =
+                _mm_movemask_epi8(_mm_cmpeq_epi8(meta, target));
+            while (hits != 0) {
+                size_t i = group + __builtin_ctz(hits);
+                // A 7-bit tag hit is almost always the key we want.
+                if (__builtin_expect(place[i].hash == hash32, 1) &&
+                    elements_[place[i].index].first == key) {
+                    return i;
+                }
+                hits &= hits - 1;
+            }
+            uint32_t empties =
+                _mm_movemask_epi8(_mm_cmpeq_epi8(meta, empty));
+            // At the working density most probes end in their home group.
+            if (__builtin_expect(empties != 0, 1)) {
+                return group + __builtin_ctz(empties);
+            }
+            group = (group + kGroupSize) & mask;
+        }
+    }
+
+    // Robin Hood placement of a probe-array entry: walk the group sequence
+    // of `slot.hash` and, in any full group, evict a resident that sits
+    // closer to its own home than we are to ours. This bounds the maximum
+    // displacement, so worst-case probe lengths (and tail lookup latency)
+    // stay short even near the density limit. Evicting is safe because a
+    // group that is full stays full until the next Rebuild — an evicted
+    // entry's probe path can never grow an empty group it would stop at.
+    void PlaceSlot(uint8_t tag, Slot slot) {
+        size_t group = HomeGroup(slot.hash);
+        size_t distance = 0;
+        __m128i empty = _mm_set1_epi8(static_cast<char>(kEmpty));
+        for (;;) {
+            __m128i meta = _mm_load_si128(
+                reinterpret_cast<const __m128i*>(&metadata_[group]));
+            uint32_t empties =
+                _mm_movemask_epi8(_mm_cmpeq_epi8(meta, empty));
+            if (empties != 0) {
+                size_t id = group + __builtin_ctz(empties);
+                metadata_[id] = tag;
+                place_[id] = slot;
+                return;
+            }
+            if (distance > 0) {
+                for (size_t offset = 0; offset < kGroupSize; ++offset) {
+                    size_t id = group + offset;
+                    if (metadata_[id] == kTombstone) {
+                        continue;
+                    }
+                    size_t resident_distance =
+                        ((group - HomeGroup(place_[id].hash)) & mask_) /
+                        kGroupSize;
+                    if (resident_distance < distance) {
+                        std::swap(tag, metadata_[id]);
+                        std::swap(slot, place_[id]);
+                        distance = resident_distance;
+                        break;
+                    }
+                }
+            }
+            group = (group + kGroupSize) & mask_;
+            ++distance;
+        }
+    }
+
+    // Returns the new element's index into elements_. Takes the element by
+    // value so rvalue callers move all the way into the storage.
+    size_t AddElement(Element value) {
+        if (elements_.size() >= kMaxElements) {
+            throw std::length_error("HashMap: element count limit reached");
+        }
+        size_t hash = hasher_(value.first);
+        size_t index = elements_.size();
+        PlaceSlot(Tag(hash),
+                  Slot{static_cast<uint32_t>(hash),
+                       static_cast<uint32_t>(index)});
+        elements_.emplace_back(std::move(value));
+        // Tombstones count against the density too: they occupy probe slots
+        // until the next Rebuild sweeps them out.
+        if ((elements_.size() + tombstones_) * kSizeChange >= place_.size()) {
+            Rebuild();
+        }
+        return index;
+    }
+
+    void DeleteElement(size_t id) {
+        size_t index = place_[id].index;
+        metadata_[id] = kTombstone;
+        if (index + 1 != elements_.size()) {
+            // The last element takes the freed index; one probe for its key
+            // finds the slot that has to be repointed, which used to need a
+            // whole reverse index array. Probe before the swap, while
+            // place_ still agrees with the element positions.
+            size_t moved = FindPlace(elements_.back().first);
+            std::swap(elements_[index], elements_.back());
+            place_[moved].index = static_cast<uint32_t>(index);
+        }
+        elements_.pop_back();
+        ++tombstones_;
+    }
+
+    // First empty slot of `hash`'s probe sequence, following the same group
+    // order as FindPlace but skipping tag and key comparisons entirely.
+    size_t FindEmpty(size_t hash) const {
+        const uint8_t* __restrict metadata = metadata_.data();
+        const size_t mask = mask_;
+        __m128i empty = _mm_set1_epi8(static_cast<char>(kEmpty));
+        size_t group = (hash & mask) & ~(kGroupSize - 1);
+        for (;;) {
+            __m128i meta = _mm_load_si128(
+                reinterpret_cast<const __m128i*>(&metadata[group]));
+            uint32_t empties =
+                _mm_movemask_epi8(_mm_cmpeq_epi8(meta, empty));
+            if (empties != 0) {
+                return group + __builtin_ctz(empties);
+            }
+            group = (group + kGroupSize) & mask;
+        }
+    }
+
+    // Re-slots the probe arrays, sized for at least `expected` elements (or
+    // the current element count if that is larger).
+    void Rebuild(size_t expected = 0) {
+        size_t needed = std::max(elements_.size(), expected);
+        // Every sizing path funnels through here, so this is where the
+        // kMaxElements invariant (32-bit indices, capacity within 32 bits)
+        // is enforced — reserve() and the range constructor included.
+        if (needed > kMaxElements) {
+            throw std::length_error("HashMap: element count limit reached");
+        }
+        // Capacity is a power of two, so slot selection is `hash & mask_`
+        // instead of a division; any power of two >= kGroupSize also keeps
+        // groups from running off the end of the metadata array.
+        size_t capacity = kGroupSize;
+        while (capacity < needed * kSizeChange + 1) {
+            capacity <<= 1;
+        }
+        mask_ = capacity - 1;
+        // The density check fires before elements_ can outgrow half the
+        // table, so one up-front reservation covers every insert until the
+        // next Rebuild and element storage stays a single contiguous block.
+        elements_.reserve(capacity / kSizeChange + 1);
+        metadata_.assign(capacity, kEmpty);
+        place_.assign(capacity, Slot{0, 0});
+        tombstones_ = 0;
+        // Elements stay where they are; rebuilding only re-slots the probe
+        // arrays. No key comparisons are needed because the table cannot
+        // contain duplicates, and no insert can re-trigger the density check.
+        for (size_t index = 0; index < elements_.size(); ++index) {
+            size_t hash = hasher_(elements_[index].first);
+            size_t id = FindEmpty(hash);
+            metadata_[id] = Tag(hash);
+            place_[id] = Slot{static_cast<uint32_t>(hash),
+                              static_cast<uint32_t>(index)};
+        }
+    }
+
+    std::vector<Element> elements_;
+    AlignedVector<uint8_t> metadata_;
+    AlignedVector<Slot> place_;
+    size_t mask_ = 0;
+    size_t tombstones_ = 0;
+    Hash hasher_;
+};